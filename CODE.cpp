@@ -5,15 +5,23 @@
 #include <list>
 #include <string>
 #include <deque>
+#include <algorithm>
 #include <climits>
 #include <chrono>  // Include the chrono library for timing
 #include <cstring>
+#include <cstdio>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
 #include <cmath> // For A* algorithm heuristic
 #include <ctime> // For time functionality
 #ifdef _WIN32
 #include <windows.h>
+#include <io.h>
+#include <fcntl.h>
 #else
 #include <unistd.h>
+#include <fcntl.h>
 #endif
 
 using namespace std;
@@ -67,68 +75,583 @@ void loadingScreen()
 class Airport {
 public:
     string name;
+    int id; // Index into Graph::listOfAirports, used as the airport's handle
 
     Airport(string name) {
         this->name = name;
+        this->id = -1;
     }
 };
 
 typedef Airport* PAirport;
-typedef pair<int, PAirport> myPair;
 
-map<PAirport, int> dist;
-map<PAirport, PAirport> parent;
+// Flight weights can be stored as uint16_t, uint32_t or float. Path lengths
+// are summed in a wider Distance type so long routes cannot overflow the
+// weight type, and the largest Distance stands for "unreachable".
+template <typename W> struct WeightTraits;
 
-class Flight {
+template <> struct WeightTraits<uint16_t> {
+    typedef uint32_t Distance;
+};
+
+template <> struct WeightTraits<uint32_t> {
+    typedef uint64_t Distance;
+};
+
+template <> struct WeightTraits<float> {
+    typedef double Distance;
+};
+
+// Result of a budget-bounded search: parallel arrays of the airport IDs
+// reached and their cost (distance or number of flights) from the source,
+// in the order they were settled.
+template <typename D>
+struct BasicReachResult {
+    vector<int> ids;
+    vector<D> costs;
+};
+
+// A route as compact arrays: airport IDs from source to destination, and for
+// each leg the flight taken and its distance. legFlights[i] and
+// legDistances[i] describe the hop from airports[i] to airports[i + 1].
+// Names are not copied in; read them through Graph::routeNames.
+template <typename W>
+struct BasicRoute {
+    vector<int> airports;
+    vector<int> legFlights;
+    vector<W> legDistances;
+    typename WeightTraits<W>::Distance totalDistance;
+
+    void clear() {
+        airports.clear();
+        legFlights.clear();
+        legDistances.clear();
+        totalDistance = 0;
+    }
+};
+
+// Read-only view of the airport names along a Route. Holds references only,
+// so it must not outlive the Route or the Graph it came from.
+class RouteNames {
+    const vector<int> &ids;
+    const vector<PAirport> &airports;
+
+public:
+    RouteNames(const vector<int> &ids, const vector<PAirport> &airports) : ids(ids), airports(airports) {}
+
+    size_t size() const {
+        return ids.size();
+    }
+
+    const string &operator[](size_t i) const {
+        return airports[ids[i]]->name;
+    }
+};
+
+// Buffered output. Text is appended to a buffer that is kept between uses
+// and handed to cout in one write on flush(), rather than flushing the
+// stream after every line with endl.
+class OutputWriter {
+    string buffer;
+
+public:
+    OutputWriter &operator<<(const string &s) {
+        buffer.append(s);
+        return *this;
+    }
+
+    OutputWriter &operator<<(const char *s) {
+        buffer.append(s);
+        return *this;
+    }
+
+    OutputWriter &operator<<(char c) {
+        buffer.push_back(c);
+        return *this;
+    }
+
+    // Any integer or floating point number other than char
+    template <typename T>
+    typename enable_if<is_arithmetic<T>::value && !is_same<T, char>::value, OutputWriter &>::type
+    operator<<(T n) {
+        char digits[32];
+        int len;
+        if (is_floating_point<T>::value) {
+            len = snprintf(digits, sizeof digits, "%g", static_cast<double>(n));
+        } else if (is_signed<T>::value) {
+            len = snprintf(digits, sizeof digits, "%lld", static_cast<long long>(n));
+        } else {
+            len = snprintf(digits, sizeof digits, "%llu", static_cast<unsigned long long>(n));
+        }
+        buffer.append(digits, len);
+        return *this;
+    }
+
+    // Write s as a quoted, escaped JSON string
+    void writeJsonString(const string &s) {
+        buffer.push_back('"');
+        for (char c : s) {
+            if (c == '"' || c == '\\') {
+                buffer.push_back('\\');
+                buffer.push_back(c);
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                char esc[8];
+                snprintf(esc, sizeof esc, "\\u%04x", c);
+                buffer.append(esc);
+            } else {
+                buffer.push_back(c);
+            }
+        }
+        buffer.push_back('"');
+    }
+
+    void flush() {
+        cout.write(buffer.data(), buffer.size());
+        buffer.clear(); // Keeps its capacity for the next use
+    }
+};
+
+// Per-query working arrays indexed by airport ID. They are kept on the Graph
+// and reused by every search, so once they have grown to the number of
+// airports a query does no heap allocation. An entry only counts if its stamp
+// matches the current epoch, which makes starting a new query O(1) instead of
+// clearing every array.
+template <typename D>
+class SearchScratch {
+public:
+    typedef pair<D, int> Entry; // Distance and airport ID
+
+private:
+    vector<D> dist;
+    vector<int> parent; // -1 for a search's starting airports
+    vector<int> parentFlight; // Flight taken into each airport, so legs need no lookup
+    vector<unsigned> stamp;
+    vector<unsigned> targetStamp;
+    vector<Entry> heap; // Min-heap on distance, storage reused across queries
+    vector<int> fifo; // Breadth-first queue of airport IDs, storage reused too
+    size_t fifoHead;
+    unsigned epoch;
+
+public:
+    SearchScratch() {
+        fifoHead = 0;
+        epoch = 0;
+    }
+
+    void resize(size_t n) {
+        dist.resize(n, infinity());
+        parent.resize(n, -1);
+        parentFlight.resize(n, -1);
+        stamp.resize(n, 0);
+        targetStamp.resize(n, 0);
+    }
+
+    // Invalidate the previous query's state
+    void begin() {
+        heap.clear();
+        fifo.clear();
+        fifoHead = 0;
+        if (++epoch == 0) { // Wrapped around, old stamps could look current
+            fill(stamp.begin(), stamp.end(), 0);
+            fill(targetStamp.begin(), targetStamp.end(), 0);
+            epoch = 1;
+        }
+    }
+
+    static D infinity() {
+        return numeric_limits<D>::max();
+    }
+
+    D getDist(int a) const {
+        return stamp[a] == epoch ? dist[a] : infinity();
+    }
+
+    int getParent(int a) const {
+        return stamp[a] == epoch ? parent[a] : -1;
+    }
+
+    int getParentFlight(int a) const {
+        return stamp[a] == epoch ? parentFlight[a] : -1;
+    }
+
+    void setDist(int a, D d, int p, int flight = -1) {
+        stamp[a] = epoch;
+        dist[a] = d;
+        parent[a] = p;
+        parentFlight[a] = flight;
+    }
+
+    void markTarget(int a) {
+        targetStamp[a] = epoch;
+    }
+
+    bool isTarget(int a) const {
+        return targetStamp[a] == epoch;
+    }
+
+    void push(D d, int a) {
+        heap.push_back(make_pair(d, a));
+        push_heap(heap.begin(), heap.end(), greater<Entry>());
+    }
+
+    Entry pop() {
+        pop_heap(heap.begin(), heap.end(), greater<Entry>());
+        Entry top = heap.back();
+        heap.pop_back();
+        return top;
+    }
+
+    bool empty() const {
+        return heap.empty();
+    }
+
+    void enqueue(int a) {
+        fifo.push_back(a);
+    }
+
+    // Next airport in first-in first-out order, false once the queue is empty
+    bool dequeue(int &a) {
+        if (fifoHead == fifo.size()) {
+            return false;
+        }
+        a = fifo[fifoHead++];
+        return true;
+    }
+};
+
+// Endpoints are airport IDs, so the record is 12 bytes for 16-bit weights
+// and 16 bytes for 32-bit ones
+template <typename W>
+class BasicFlight {
 public:
-    PAirport origin;
-    PAirport destination;
-    int distance;
+    int origin;
+    int destination;
+    W distance;
+    bool cancelled; // Kept in place so flight IDs stay stable
 
-    Flight(PAirport origin, PAirport destination, int distance) {
+    BasicFlight(int origin, int destination, W distance) {
         this->origin = origin;
         this->destination = destination;
         this->distance = distance;
+        this->cancelled = false;
+    }
+};
+
+// What a search sees of one arc. A directed graph stores these as they are;
+// an undirected one assembles them from the Flight (see BasicAdjacency).
+template <typename W>
+struct BasicArc {
+    int to;
+    int flight; // Index into Graph::flights
+    W distance;
+};
+
+// Arcs leaving one airport. The layout depends on the graph variant.
+template <typename W, bool Directed>
+class BasicAdjacency;
+
+// Directed: each arc has its own target and weight, so whole arcs are packed
+// into one array per airport and relaxing an arc reads a single record
+template <typename W>
+class BasicAdjacency<W, true> {
+    vector<BasicArc<W>> arcs;
+
+public:
+    size_t size() const {
+        return arcs.size();
+    }
+
+    BasicArc<W> at(size_t k, int, const vector<BasicFlight<W>> &) const {
+        return arcs[k];
+    }
+
+    void add(int target, W w, int id) {
+        BasicArc<W> arc = { target, id, w };
+        arcs.push_back(arc);
+    }
+
+    void remove(int id) {
+        for (size_t k = 0; k < arcs.size(); ) {
+            if (arcs[k].flight == id) {
+                arcs.erase(arcs.begin() + k);
+            } else {
+                k++;
+            }
+        }
+    }
+
+    void renumber(const vector<int> &newId) {
+        for (auto &arc : arcs) {
+            arc.flight = newId[arc.flight];
+        }
+    }
+};
+
+// Undirected: only the flight ID. The endpoints and weight are stored once,
+// in the flight record, and shared by both directions; the far end is
+// origin ^ destination ^ self.
+template <typename W>
+class BasicAdjacency<W, false> {
+    vector<int> flight;
+
+public:
+    size_t size() const {
+        return flight.size();
+    }
+
+    BasicArc<W> at(size_t k, int self, const vector<BasicFlight<W>> &flights) const {
+        const BasicFlight<W> &f = flights[flight[k]];
+        BasicArc<W> arc = { f.origin ^ f.destination ^ self, flight[k], f.distance };
+        return arc;
+    }
+
+    void add(int, W, int id) {
+        flight.push_back(id);
+    }
+
+    void remove(int id) {
+        flight.erase(std::remove(flight.begin(), flight.end(), id), flight.end());
+    }
+
+    void renumber(const vector<int> &newId) {
+        for (auto &id : flight) {
+            id = newId[id];
+        }
+    }
+};
+
+// Lets the search loops write "for (Arc i : arcsOf(u))" for either layout
+template <typename W, bool Directed>
+class ArcRange {
+    const BasicAdjacency<W, Directed> &adjacency;
+    const vector<BasicFlight<W>> &flights;
+    int self;
+
+public:
+    ArcRange(const BasicAdjacency<W, Directed> &adjacency, const vector<BasicFlight<W>> &flights, int self)
+        : adjacency(adjacency), flights(flights), self(self) {}
+
+    class iterator {
+        const ArcRange *range;
+        size_t k;
+
+    public:
+        iterator(const ArcRange *range, size_t k) : range(range), k(k) {}
+
+        BasicArc<W> operator*() const {
+            return range->adjacency.at(k, range->self, range->flights);
+        }
+
+        iterator &operator++() {
+            k++;
+            return *this;
+        }
+
+        bool operator!=(const iterator &other) const {
+            return k != other.k;
+        }
+    };
+
+    iterator begin() const {
+        return iterator(this, 0);
+    }
+
+    iterator end() const {
+        return iterator(this, adjacency.size());
     }
 };
 
-class Graph
+// A set of airports serving the same city (e.g. all London airports). A group
+// is searched as one endpoint: any member may start or end the journey.
+class AirportGroup {
+public:
+    string name;
+    vector<PAirport> members;
+
+    AirportGroup(string name) {
+        this->name = name;
+    }
+};
+
+class Journal;
+
+// The flight network. W is the weight type of a flight's distance. A
+// directed graph only lets a flight be taken from origin to destination and
+// stores each arc's target and weight with the arc; an undirected one keeps
+// them once in the Flight and only the flight ID at each end (see
+// BasicAdjacency). Both are fixed at compile time, so the search loops carry
+// no per-edge checks for either.
+template <typename W, bool Directed>
+class BasicGraph
 {
-    map<PAirport, vector<pair<PAirport, int>>> adj;
-    void printAllUtils(PAirport src, PAirport dest, map<PAirport, bool> &visit, vector<string> &path, int &);
+public:
+    typedef W Weight;
+    typedef typename WeightTraits<W>::Distance Distance;
+    typedef BasicFlight<W> Flight;
+    typedef BasicArc<W> Arc;
+    typedef BasicAdjacency<W, Directed> Adjacency;
+    typedef BasicRoute<W> Route;
+    typedef BasicReachResult<Distance> ReachResult;
+
+private:
+    typedef SearchScratch<Distance> Scratch;
+    typedef typename Scratch::Entry QueueEntry;
+
+    deque<Airport> airportPool; // Owns every Airport; deque keeps addresses stable as it grows
+    vector<Adjacency> adj; // Indexed by airport ID
+    Scratch scratch; // Reused by every search
+    Route route; // Filled for the printing queries below, buffers reused
+    OutputWriter out;
+    void printAllUtils(PAirport src, PAirport dest, vector<bool> &visit, vector<string> &path, int &);
+
+    ArcRange<W, Directed> arcsOf(int airport) const {
+        return ArcRange<W, Directed>(adj[airport], flights, airport);
+    }
 
 public:
     vector<PAirport> listOfAirports;
     vector<Flight> flights; // Store flights
+    list<AirportGroup> groups; // City airport groups (list keeps pointers stable)
+    Journal *journal; // Receives every change once attached, null while recovering
+
+    BasicGraph() {
+        journal = nullptr;
+    }
+
+    static Distance infinity() {
+        return Scratch::infinity();
+    }
 
-    void addFlight(PAirport u, PAirport v, int w, bool bidirected);
-    void shortestPath(PAirport s, PAirport d);
+    void addFlight(PAirport u, PAirport v, W w);
+    bool findShortestPath(PAirport s, PAirport d, Route &result); // Search only, no output
+    bool findAStarPath(PAirport s, PAirport d, Route &result);
+    void shortestPath(PAirport s, PAirport d, bool asJson = false); // Search, then print the route
     void aStarPath(PAirport s, PAirport d); // New A* Algorithm function
-    void addAirport(PAirport a);
+    PAirport addAirport(string name); // Allocates the airport from the Graph's pool
+    bool doesPathExist(PAirport src, PAirport dest);
     void viewMap();
     void PrintAllPaths(PAirport src, PAirport dest);
     PAirport SearchAirport(string abc);
     void viewFlights(); // View all flights
     void scheduleFlight(); // New feature to schedule a flight
     void cancelFlight(); // New feature to cancel a flight
+    void removeFlight(int index);
+    void dropCancelledFlights();
+    void reachableWithinDistance(PAirport src, Distance maxDistance, ReachResult &result); // Dijkstra cut off at the budget
+    void reachableWithinFlights(PAirport src, int maxFlights, ReachResult &result); // BFS cut off at the hop limit
+    void distanceTable(PAirport src, vector<Distance> &table); // One-to-all distances indexed by airport ID
+    void printReachable(const ReachResult &result, string unit);
+    void printDistanceTable(PAirport src, const vector<Distance> &table);
+    AirportGroup* addGroup(string name);
+    AirportGroup* SearchGroup(string name);
+    bool findGroupPath(const AirportGroup &from, const AirportGroup &to, Route &result); // One search for any-to-any
+    void groupShortestPath(const AirportGroup &from, const AirportGroup &to);
+    void buildRoute(PAirport dest, Route &result); // From the parents left by the last search
+    RouteNames routeNames(const Route &result) const;
+    void writeRouteText(const Route &result, OutputWriter &writer) const;
+    void writeRouteJson(const Route &result, OutputWriter &writer) const;
+};
+
+// The variant this program is built with: distances in whole km fit in 16
+// bits, and every flight can be flown in both directions
+typedef BasicGraph<uint16_t, false> Graph;
+
+// Weights go to disk as 32 raw bits whatever the weight type
+template <typename W>
+uint32_t weightToBits(W w) {
+    if (is_floating_point<W>::value) {
+        float f = w;
+        uint32_t bits;
+        memcpy(&bits, &f, sizeof bits);
+        return bits;
+    }
+    return static_cast<uint32_t>(w);
+}
+
+// Decodes w from its disk form. Returns false if the value is negative, NaN
+// or does not fit W, which only a damaged or foreign file can contain.
+template <typename W>
+bool weightFromBits(uint32_t bits, W &w) {
+    if (is_floating_point<W>::value) {
+        float f;
+        memcpy(&f, &bits, sizeof f);
+        if (!(f >= 0 && f <= numeric_limits<W>::max())) {
+            return false;
+        }
+        w = static_cast<W>(f);
+        return true;
+    }
+    if (bits > numeric_limits<W>::max()) {
+        return false;
+    }
+    w = static_cast<W>(bits);
+    return true;
+}
+
+// Identifies the graph variant a file was written for: the weight's size,
+// whether it is floating point, and whether flights are directed. Files of
+// another variant must not be decoded, as their weights mean something else.
+template <typename W, bool Directed>
+uint32_t graphFormat(const BasicGraph<W, Directed> &) {
+    return sizeof(W) | (is_floating_point<W>::value ? 0x100 : 0) | (Directed ? 0x200 : 0);
+}
+
+// Write-ahead journal of schedule changes, on top of a base snapshot of the
+// whole graph. Records are only appended, and are buffered until commit(),
+// which writes the batch and fsyncs once (group commit). On startup the
+// snapshot is loaded and the journal replayed over it; compact() folds the
+// journal into a new snapshot. Airports and flights are recorded by ID, which
+// replay reproduces exactly since both are applied in the same order.
+//
+// Both files start with the graph format (see graphFormat) and a generation
+// number. A journal only applies to the snapshot of the same generation, so a
+// crash between writing a new snapshot and resetting the journal cannot
+// replay old records twice.
+class Journal {
+    string snapshotPath;
+    string journalPath;
+    FILE *file;
+    long long fileSize; // Bytes of whole records in the file, where a failed write is cut back to
+    string pending; // Encoded records not yet written
+    int pendingRecords;
+    int recordCount; // Records in the journal file since the last snapshot
+    uint32_t generation;
+
+    bool resetFile(const string &contents);
+
+public:
+    enum RecordType { ADD_AIRPORT = 1, ADD_FLIGHT = 2, CANCEL_FLIGHT = 3 };
+
+    static const int BATCH_RECORDS = 256; // Commit automatically past this many
+    static const int COMPACT_RECORDS = 10000; // Snapshot once the journal is this long
+
+    Journal(string snapshotPath, string journalPath);
+    ~Journal();
+
+    template <typename G> bool loadSnapshot(G &g);
+    template <typename G> int replay(G &g); // Returns the number of records applied
+    void logAddAirport(const string &name);
+    void logAddFlight(int origin, int destination, uint32_t weightBits);
+    void logCancelFlight(int index);
+    bool commit();
+    template <typename G> void compact(G &g);
+    template <typename G> void compactIfNeeded(G &g);
 };
 
-void Graph::PrintAllPaths(PAirport src, PAirport dest)
+template <typename W, bool Directed>
+void BasicGraph<W, Directed>::PrintAllPaths(PAirport src, PAirport dest)
 {
-    map<PAirport, bool> visit;
+    vector<bool> visit(listOfAirports.size(), false);
     vector<string> path(100);
     int path_index = 0;
 
-    for (auto itr : listOfAirports)
-    {
-        visit[itr] = false;
-    }
     printAllUtils(src, dest, visit, path, path_index);
 }
 
-void Graph::printAllUtils(PAirport src, PAirport dest, map<PAirport, bool> &visit, vector<string> &path, int &path_index)
+template <typename W, bool Directed>
+void BasicGraph<W, Directed>::printAllUtils(PAirport src, PAirport dest, vector<bool> &visit, vector<string> &path, int &path_index)
 {
-    visit[src] = true;
+    visit[src->id] = true;
     path[path_index] = src->name;
     path_index++;
 
@@ -140,19 +663,20 @@ void Graph::printAllUtils(PAirport src, PAirport dest, map<PAirport, bool> &visi
     }
     else
     {
-        for (pair<PAirport, int> i : adj[src])
+        for (Arc i : arcsOf(src->id))
         {
-            if (!visit[i.first])
+            if (!visit[i.to])
             {
-                printAllUtils(i.first, dest, visit, path, path_index);
+                printAllUtils(listOfAirports[i.to], dest, visit, path, path_index);
             }
         }
     }
     path_index--;
-    visit[src] = false;
+    visit[src->id] = false;
 }
 
-PAirport Graph::SearchAirport(string abc)
+template <typename W, bool Directed>
+PAirport BasicGraph<W, Directed>::SearchAirport(string abc)
 {
     for (auto itr : listOfAirports)
     {
@@ -164,93 +688,141 @@ PAirport Graph::SearchAirport(string abc)
     return NULL;
 }
 
-void Graph::addFlight(PAirport u, PAirport v, int w, bool bidirected)
+template <typename W, bool Directed>
+void BasicGraph<W, Directed>::addFlight(PAirport u, PAirport v, W w)
 {
-    if (bidirected) {
-        adj[u].push_back(make_pair(v, w));
-        adj[v].push_back(make_pair(u, w));
-    } else {
-        adj[u].push_back(make_pair(v, w));
+    int id = flights.size();
+    adj[u->id].add(v->id, w, id);
+    if (!Directed && v != u) {
+        adj[v->id].add(u->id, w, id); // Same flight, flown the other way
     }
 
     // Store the flight information
-    flights.push_back(Flight(u, v, w));
+    flights.push_back(Flight(u->id, v->id, w));
+
+    if (journal) {
+        journal->logAddFlight(u->id, v->id, weightToBits(w));
+    }
 }
 
-void Graph::addAirport(PAirport a) {
+template <typename W, bool Directed>
+PAirport BasicGraph<W, Directed>::addAirport(string name) {
+    airportPool.push_back(Airport(name));
+    PAirport a = &airportPool.back();
+    a->id = listOfAirports.size();
     listOfAirports.push_back(a);
-}
 
-bool doesPathExist(PAirport dest) {
-    return dist[dest] != INT_MAX;
+    // Grow the per-airport arrays here so searches never have to
+    adj.resize(listOfAirports.size());
+    scratch.resize(listOfAirports.size());
+
+    if (journal) {
+        journal->logAddAirport(name);
+    }
+    return a;
 }
 
-void Graph::shortestPath(PAirport src, PAirport dest)
+// Early-exit breadth-first search, no distances needed
+template <typename W, bool Directed>
+bool BasicGraph<W, Directed>::doesPathExist(PAirport src, PAirport dest)
 {
-    using namespace std::chrono; // For timing
-
-    // Start measuring time
-    auto start = high_resolution_clock::now();
+    scratch.begin();
+    scratch.setDist(src->id, 0, -1);
+    scratch.enqueue(src->id);
 
-    // Initialize distances to infinity
-    for (auto v : listOfAirports) {
-        dist[v] = INT_MAX;
+    int u;
+    while (scratch.dequeue(u))
+    {
+        if (u == dest->id) {
+            return true;
+        }
+        for (Arc i : arcsOf(u)) {
+            if (scratch.getDist(i.to) == infinity()) {
+                scratch.setDist(i.to, scratch.getDist(u) + 1, u, i.flight);
+                scratch.enqueue(i.to);
+            }
+        }
     }
+    return false;
+}
 
-    priority_queue<myPair, vector<myPair>, greater<myPair>> pq;
-
-    pq.push(make_pair(0, src));
-    dist[src] = 0;
-    parent[src] = nullptr;
+// Dijkstra from src, stopping once dest is settled. Fills the caller's Route
+// with IDs, flights and leg distances only; nothing is formatted. Returns
+// false, leaving the Route empty, if dest cannot be reached.
+template <typename W, bool Directed>
+bool BasicGraph<W, Directed>::findShortestPath(PAirport src, PAirport dest, Route &result)
+{
+    // All distances start at infinity
+    scratch.begin();
+    scratch.push(0, src->id);
+    scratch.setDist(src->id, 0, -1);
 
     // Dijkstra's algorithm to find the shortest path
-    while (!pq.empty())
+    while (!scratch.empty())
     {
-        PAirport u = pq.top().second;
-        pq.pop();
+        QueueEntry top = scratch.pop();
+        int u = top.second;
+
+        if (top.first > scratch.getDist(u)) {
+            continue; // Stale entry, u was already settled closer
+        }
+        if (u == dest->id) {
+            buildRoute(dest, result);
+            return true;
+        }
 
-        for (pair<PAirport, int> i : adj[u]) {
-            PAirport v = i.first;
-            int weight = i.second;
+        for (Arc i : arcsOf(u)) {
+            int v = i.to;
+            Distance weight = i.distance;
 
-            if (dist[v] > dist[u] + weight) {
-                dist[v] = dist[u] + weight;
-                pq.push(make_pair(dist[v], v));
-                parent[v] = u;
+            if (scratch.getDist(v) > top.first + weight) {
+                scratch.setDist(v, top.first + weight, u, i.flight);
+                scratch.push(top.first + weight, v);
             }
         }
     }
 
+    result.clear();
+    return false;
+}
+
+template <typename W, bool Directed>
+void BasicGraph<W, Directed>::shortestPath(PAirport src, PAirport dest, bool asJson)
+{
+    using namespace std::chrono; // For timing
+
+    // Start measuring time
+    auto start = high_resolution_clock::now();
+
+    bool found = findShortestPath(src, dest, route);
+
     // End measuring time
     auto stop = high_resolution_clock::now();
 
     // Calculate the duration the algorithm took to compute the shortest path
     auto duration = duration_cast<milliseconds>(stop - start);
 
-    if (doesPathExist(dest)) {
+    if (asJson) {
+        if (found) {
+            writeRouteJson(route, out);
+        } else {
+            // Still a JSON document, so a consumer can parse every answer
+            out << "{\"distance\":null,\"airports\":[],\"legs\":[]}";
+        }
+        out << '\n';
+        out.flush();
+    } else if (found) {
         // Output the shortest distance
-        cout << endl << "Shortest Flight Distance between " << src->name << " and " << dest->name << " is " << dist[dest] << " km." << endl;
+        out << "\nShortest Flight Distance between " << src->name << " and " << dest->name << " is " << route.totalDistance << " km.\n";
 
         // Output the shortest route
-        cout << "Shortest Route using Dijkstra's Algorithm is: ";
-        
-        // Reconstruct the path from the destination to the source
-        vector<string> path;
-        PAirport current = dest;
-
-        while (current != nullptr) {
-            path.push_back(current->name);  // Add the airport to the path
-            current = parent[current];      // Move to the parent airport
-        }
-
-        // Print the path from source to destination (reverse the order)
-        for (int i = path.size() - 1; i > 0; --i) {
-            cout << path[i] << " -> ";  // Print all airports except the source
-        }
-        cout << path[0] << endl;  // Print the source airport last
+        out << "Shortest Route using Dijkstra's Algorithm is: ";
+        writeRouteText(route, out);
+        out << '\n';
 
         // Show the time it took to compute the shortest path
-        cout << "Time taken to compute the shortest path: " << duration.count() << " milliseconds." << endl;
+        out << "Time taken to compute the shortest path: " << static_cast<long long>(duration.count()) << " milliseconds.\n";
+        out.flush();
     } else {
         cout << "No Path Exists between " << src->name << " and " << dest->name << endl << endl;
     }
@@ -263,96 +835,381 @@ int heuristic(PAirport a, PAirport b) {
     return abs(static_cast<int>(a->name.length()) - static_cast<int>(b->name.length()));
 }
 
-void Graph::aStarPath(PAirport src, PAirport dest)
+// A* search from src to dest, filling the caller's Route like
+// findShortestPath. Returns false if dest cannot be reached.
+template <typename W, bool Directed>
+bool BasicGraph<W, Directed>::findAStarPath(PAirport src, PAirport dest, Route &result)
+{
+    // The scratch distances hold g_score; f_score only lives in the open set
+    scratch.begin();
+    scratch.push(heuristic(src, dest), src->id);
+    scratch.setDist(src->id, 0, -1);
+
+    // A* algorithm to find the optimal path
+    while (!scratch.empty()) {
+        int current = scratch.pop().second;
+
+        if (current == dest->id) {
+            // Leg distances come from the flight recorded for each hop
+            buildRoute(dest, result);
+            return true;
+        }
+
+        // Explore neighbors
+        for (Arc i : arcsOf(current)) {
+            int neighbor = i.to;
+            Distance tentative_gScore = scratch.getDist(current) + i.distance;
+
+            if (tentative_gScore < scratch.getDist(neighbor)) {
+                scratch.setDist(neighbor, tentative_gScore, current, i.flight);
+                scratch.push(tentative_gScore + heuristic(listOfAirports[neighbor], dest), neighbor);
+            }
+        }
+    }
+
+    result.clear();
+    return false;
+}
+
+template <typename W, bool Directed>
+void BasicGraph<W, Directed>::aStarPath(PAirport src, PAirport dest)
 {
     using namespace std::chrono; // For timing
 
     // Start measuring time
     auto start = high_resolution_clock::now();
 
-    map<PAirport, int> g_score, f_score;
-    for (auto v : listOfAirports) {
-        g_score[v] = INT_MAX;
-        f_score[v] = INT_MAX;
+    bool found = findAStarPath(src, dest, route);
+
+    // End measuring time
+    auto stop = high_resolution_clock::now();
+
+    // Calculate the duration the algorithm took to compute the path
+    auto duration = duration_cast<milliseconds>(stop - start);
+
+    if (!found) {
+        cout << "No A* Path Exists between " << src->name << " and " << dest->name << endl;
+        return;
     }
 
-    priority_queue<myPair, vector<myPair>, greater<myPair>> openSet;
-    openSet.push(make_pair(0, src));
-    g_score[src] = 0;
-    f_score[src] = heuristic(src, dest);
-    parent[src] = nullptr;
+    // Output the A* route
+    out << "\nA* Path from " << src->name << " to " << dest->name << " found with cost " << route.totalDistance << '\n';
+    out << "A* Route is: ";
+    writeRouteText(route, out);
+    out << '\n';
 
-    // A* algorithm to find the optimal path
-    while (!openSet.empty()) {
-        PAirport current = openSet.top().second;
-        openSet.pop();
-
-        if (current == dest) {
-            // End measuring time
-            auto stop = high_resolution_clock::now();
-
-            // Calculate the duration the algorithm took to compute the path
-            auto duration = duration_cast<milliseconds>(stop - start);
-
-            // Output the A* route
-            cout << "\nA* Path from " << src->name << " to " << dest->name << " found with cost " << g_score[dest] << endl;
-            cout << "A* Route is: ";
-
-            // Reconstruct the path from destination to source
-            vector<string> path;
-            int totalWeight = 0;  // Variable to accumulate the total distance (weight)
-            PAirport cur = dest;
-
-            while (cur != nullptr) {
-                path.push_back(cur->name);
-                if (parent[cur] != nullptr) {
-                    // Add the distance between the current airport and its parent
-                    // Look up the distance from the adjacency list (adj)
-                    for (const auto& pair : adj[parent[cur]]) {
-                        if (pair.first == cur) {
-                            totalWeight += pair.second;  // Add the weight (distance)
-                            break;
-                        }
-                    }
-                }
-                cur = parent[cur];
+    // Show the total weight of the path
+    out << "Total Weight (Distance): " << route.totalDistance << " km\n";
+
+    // Show the time it took to compute the path
+    out << "Time taken to compute the A* path: " << static_cast<long long>(duration.count()) << " milliseconds.\n";
+    out.flush();
+}
+
+
+
+// Range query: every airport whose shortest flight distance from src is at
+// most maxDistance. Airports leave the queue in distance order, so the search
+// stops at the first one over budget instead of exploring the whole graph.
+template <typename W, bool Directed>
+void BasicGraph<W, Directed>::reachableWithinDistance(PAirport src, Distance maxDistance, ReachResult &result)
+{
+    result.ids.clear();
+    result.costs.clear();
+
+    scratch.begin();
+    scratch.setDist(src->id, 0, -1);
+    scratch.push(0, src->id);
+
+    while (!scratch.empty())
+    {
+        QueueEntry top = scratch.pop();
+        Distance d = top.first;
+        int u = top.second;
+
+        if (d > maxDistance) {
+            break; // Everything left in the queue is further away
+        }
+        if (d > scratch.getDist(u)) {
+            continue; // Stale entry, u was already settled closer
+        }
+
+        result.ids.push_back(u);
+        result.costs.push_back(d);
+
+        for (Arc i : arcsOf(u)) {
+            int v = i.to;
+            Distance nd = d + i.distance;
+
+            if (nd <= maxDistance && nd < scratch.getDist(v)) {
+                scratch.setDist(v, nd, u, i.flight);
+                scratch.push(nd, v);
             }
+        }
+    }
+}
+
+// Isochrone by number of flights: every airport reachable from src using at
+// most maxFlights flights. Breadth-first, so levels beyond the limit are
+// never expanded.
+template <typename W, bool Directed>
+void BasicGraph<W, Directed>::reachableWithinFlights(PAirport src, int maxFlights, ReachResult &result)
+{
+    result.ids.clear();
+    result.costs.clear();
+
+    scratch.begin();
+    scratch.setDist(src->id, 0, -1);
+    result.ids.push_back(src->id);
+    result.costs.push_back(0);
+    Distance limit = maxFlights > 0 ? maxFlights : 0;
 
-            // Print the path from source to destination (reverse the order)
-            for (int i = path.size() - 1; i > 0; --i) {
-                cout << path[i] << " -> ";  // Print all airports except the destination
+    // The result arrays double as the BFS queue
+    for (size_t head = 0; head < result.ids.size(); head++)
+    {
+        Distance h = result.costs[head];
+        if (h >= limit) {
+            break; // Remaining entries are all at the limit
+        }
+
+        int u = result.ids[head];
+        for (Arc i : arcsOf(u)) {
+            int v = i.to;
+            if (scratch.getDist(v) == infinity()) {
+                scratch.setDist(v, h + 1, u, i.flight);
+                result.ids.push_back(v);
+                result.costs.push_back(h + 1);
             }
-            cout << path[0] << endl;  // Print the source airport last
+        }
+    }
+}
 
-            // Show the total weight of the path
-            cout << "Total Weight (Distance): " << totalWeight << " km" << endl;
+// Full one-to-all sweep for when every distance is actually needed (e.g. to
+// build a distance table). Fills the caller's table, indexed by airport ID,
+// and never stops early. Unreachable airports are left at infinity().
+template <typename W, bool Directed>
+void BasicGraph<W, Directed>::distanceTable(PAirport src, vector<Distance> &table)
+{
+    table.assign(listOfAirports.size(), infinity());
 
-            // Show the time it took to compute the path
-            cout << "Time taken to compute the A* path: " << duration.count() << " milliseconds." << endl;
+    scratch.begin();
+    table[src->id] = 0;
+    scratch.push(0, src->id);
 
-            return;
+    while (!scratch.empty())
+    {
+        QueueEntry top = scratch.pop();
+        Distance d = top.first;
+        int u = top.second;
+
+        if (d > table[u]) {
+            continue;
         }
 
-        // Explore neighbors
-        for (pair<PAirport, int> i : adj[current]) {
-            PAirport neighbor = i.first;
-            int tentative_gScore = g_score[current] + i.second;
-
-            if (tentative_gScore < g_score[neighbor]) {
-                parent[neighbor] = current;
-                g_score[neighbor] = tentative_gScore;
-                f_score[neighbor] = g_score[neighbor] + heuristic(neighbor, dest);
-                openSet.push(make_pair(f_score[neighbor], neighbor));
+        for (Arc i : arcsOf(u)) {
+            Distance nd = d + i.distance;
+            if (nd < table[i.to]) {
+                table[i.to] = nd;
+                scratch.push(nd, i.to);
+            }
+        }
+    }
+}
+
+template <typename W, bool Directed>
+void BasicGraph<W, Directed>::printReachable(const ReachResult &result, string unit)
+{
+    if (result.ids.size() <= 1) {
+        cout << "No other airports are reachable within the limit." << endl;
+        return;
+    }
+
+    cout << "\nReachable Airports:\n";
+    for (size_t i = 1; i < result.ids.size(); i++) { // Entry 0 is the source itself
+        cout << listOfAirports[result.ids[i]]->name << " (" << result.costs[i] << " " << unit << ")\n";
+    }
+}
+
+template <typename W, bool Directed>
+void BasicGraph<W, Directed>::printDistanceTable(PAirport src, const vector<Distance> &table)
+{
+    cout << "\nFlight Distances from " << src->name << ":\n";
+    for (size_t i = 0; i < table.size(); i++) {
+        if ((int)i == src->id) {
+            continue;
+        }
+        cout << listOfAirports[i]->name << ": ";
+        if (table[i] == infinity()) {
+            cout << "unreachable\n";
+        } else {
+            cout << table[i] << " km\n";
+        }
+    }
+}
+
+template <typename W, bool Directed>
+AirportGroup* BasicGraph<W, Directed>::addGroup(string name)
+{
+    groups.push_back(AirportGroup(name));
+    return &groups.back();
+}
+
+template <typename W, bool Directed>
+AirportGroup* BasicGraph<W, Directed>::SearchGroup(string name)
+{
+    for (auto &group : groups)
+    {
+        if (group.name.compare(name) == 0)
+        {
+            return &group;
+        }
+    }
+    return NULL;
+}
+
+// Shortest route from any airport in one group to any airport in another.
+// All members of the origin group are seeded at distance 0 (a virtual
+// super-source), and the search stops as soon as the first member of the
+// destination group is settled, so it costs one Dijkstra instead of one per
+// origin/destination pair. Fills the caller's Route, and returns false if no
+// member of to can be reached.
+template <typename W, bool Directed>
+bool BasicGraph<W, Directed>::findGroupPath(const AirportGroup &from, const AirportGroup &to, Route &result)
+{
+    scratch.begin();
+    for (auto t : to.members) {
+        scratch.markTarget(t->id);
+    }
+    for (auto s : from.members) {
+        scratch.setDist(s->id, 0, -1);
+        scratch.push(0, s->id);
+    }
+
+    while (!scratch.empty())
+    {
+        QueueEntry top = scratch.pop();
+        Distance d = top.first;
+        int u = top.second;
+
+        if (d > scratch.getDist(u)) {
+            continue;
+        }
+        if (scratch.isTarget(u)) {
+            // First settled target is the closest one. Origin-group airports
+            // have no parent, so the route starts at whichever one was used.
+            buildRoute(listOfAirports[u], result);
+            return true;
+        }
+
+        for (Arc i : arcsOf(u)) {
+            int v = i.to;
+            Distance nd = d + i.distance;
+
+            if (nd < scratch.getDist(v)) {
+                scratch.setDist(v, nd, u, i.flight);
+                scratch.push(nd, v);
             }
         }
     }
 
-    cout << "No A* Path Exists between " << src->name << " and " << dest->name << endl;
+    result.clear();
+    return false;
+}
+
+template <typename W, bool Directed>
+void BasicGraph<W, Directed>::groupShortestPath(const AirportGroup &from, const AirportGroup &to)
+{
+    using namespace std::chrono; // For timing
+
+    auto start = high_resolution_clock::now();
+    bool found = findGroupPath(from, to, route);
+    auto stop = high_resolution_clock::now();
+    auto duration = duration_cast<milliseconds>(stop - start);
+
+    if (!found) {
+        cout << "No Path Exists between " << from.name << " and " << to.name << endl << endl;
+        return;
+    }
+
+    out << "\nShortest Flight Distance between " << from.name << " and " << to.name << " is " << route.totalDistance << " km.\n";
+    out << "Shortest Route is: ";
+    writeRouteText(route, out);
+    out << '\n';
+
+    out << "Time taken to compute the shortest path: " << static_cast<long long>(duration.count()) << " milliseconds.\n";
+    out.flush();
+}
+
+template <typename W, bool Directed>
+void BasicGraph<W, Directed>::buildRoute(PAirport dest, Route &result)
+{
+    result.clear();
+
+    // Walk back from the destination, then reverse into source-first order
+    for (int cur = dest->id; cur != -1; cur = scratch.getParent(cur)) {
+        result.airports.push_back(cur);
+        int flight = scratch.getParentFlight(cur);
+        if (flight != -1) {
+            result.legFlights.push_back(flight);
+            result.legDistances.push_back(flights[flight].distance);
+            result.totalDistance += flights[flight].distance;
+        }
+    }
+    reverse(result.airports.begin(), result.airports.end());
+    reverse(result.legFlights.begin(), result.legFlights.end());
+    reverse(result.legDistances.begin(), result.legDistances.end());
+}
+
+template <typename W, bool Directed>
+RouteNames BasicGraph<W, Directed>::routeNames(const Route &result) const
+{
+    return RouteNames(result.airports, listOfAirports);
+}
+
+// "A -> B -> C"
+template <typename W, bool Directed>
+void BasicGraph<W, Directed>::writeRouteText(const Route &result, OutputWriter &writer) const
+{
+    RouteNames names = routeNames(result);
+    for (size_t i = 0; i < names.size(); i++) {
+        if (i > 0) {
+            writer << " -> ";
+        }
+        writer << names[i];
+    }
 }
 
+// {"distance":D,"airports":[...],"legs":[{"flight":F,"from":..,"to":..,"distance":d},...]}
+// When there is no route, shortestPath writes the same shape with a null distance
+template <typename W, bool Directed>
+void BasicGraph<W, Directed>::writeRouteJson(const Route &result, OutputWriter &writer) const
+{
+    RouteNames names = routeNames(result);
+
+    writer << "{\"distance\":" << result.totalDistance << ",\"airports\":[";
+    for (size_t i = 0; i < names.size(); i++) {
+        if (i > 0) {
+            writer << ',';
+        }
+        writer.writeJsonString(names[i]);
+    }
 
+    writer << "],\"legs\":[";
+    for (size_t i = 0; i < result.legFlights.size(); i++) {
+        if (i > 0) {
+            writer << ',';
+        }
+        writer << "{\"flight\":" << result.legFlights[i] << ",\"from\":";
+        writer.writeJsonString(names[i]);
+        writer << ",\"to\":";
+        writer.writeJsonString(names[i + 1]);
+        writer << ",\"distance\":" << result.legDistances[i] << '}';
+    }
+    writer << "]}";
+}
 
-void Graph::viewMap()
+template <typename W, bool Directed>
+void BasicGraph<W, Directed>::viewMap()
 {
     for (auto itr : listOfAirports)
     {
@@ -360,16 +1217,21 @@ void Graph::viewMap()
     }
 }
 
-void Graph::viewFlights() {
+template <typename W, bool Directed>
+void BasicGraph<W, Directed>::viewFlights() {
     cout << "\nList of Flights:\n";
     for (const auto& flight : flights) {
-        cout << "Flight from " << flight.origin->name << " to " << flight.destination->name << " with distance " << flight.distance << " km\n";
+        if (flight.cancelled) {
+            continue;
+        }
+        cout << "Flight from " << listOfAirports[flight.origin]->name << " to " << listOfAirports[flight.destination]->name << " with distance " << flight.distance << " km\n";
     }
 }
 
-void Graph::scheduleFlight() {
+template <typename W, bool Directed>
+void BasicGraph<W, Directed>::scheduleFlight() {
     string originName, destName;
-    int distance;
+    double distance;
     cout << "Enter Origin Airport Name: ";
     cin >> originName;
     cout << "Enter Destination Airport Name: ";
@@ -379,24 +1241,28 @@ void Graph::scheduleFlight() {
 
     PAirport origin = SearchAirport(originName);
     PAirport destination = SearchAirport(destName);
-    if (origin && destination) {
-        addFlight(origin, destination, distance, true);
+    if (!(distance >= 0 && distance <= numeric_limits<W>::max())
+        || (!is_floating_point<W>::value && distance != floor(distance))) {
+        cout << "Invalid distance entered!\n"; // Does not fit the weight type
+    } else if (origin && destination) {
+        addFlight(origin, destination, static_cast<W>(distance));
         cout << "Flight scheduled successfully!\n";
     } else {
         cout << "Invalid airports entered!\n";
     }
 }
 
-void Graph::cancelFlight() {
+template <typename W, bool Directed>
+void BasicGraph<W, Directed>::cancelFlight() {
     string originName, destName;
     cout << "Enter Origin Airport Name: ";
     cin >> originName;
     cout << "Enter Destination Airport Name: ";
     cin >> destName;
 
-    for (auto it = flights.begin(); it != flights.end(); ++it) {
-        if (it->origin->name == originName && it->destination->name == destName) {
-            flights.erase(it);
+    for (size_t i = 0; i < flights.size(); i++) {
+        if (!flights[i].cancelled && listOfAirports[flights[i].origin]->name == originName && listOfAirports[flights[i].destination]->name == destName) {
+            removeFlight(i);
             cout << "Flight cancelled successfully!\n";
             return;
         }
@@ -404,7 +1270,492 @@ void Graph::cancelFlight() {
     cout << "Flight not found!\n";
 }
 
-vector<PAirport>* getSourceAndDestinationAirports(Graph &g) {
+// Drops the flight from the route network. The entry in the flight list is
+// only marked cancelled, so flight IDs held by arcs, routes and the journal
+// stay valid until compaction, which calls dropCancelledFlights.
+template <typename W, bool Directed>
+void BasicGraph<W, Directed>::removeFlight(int index)
+{
+    if (journal) {
+        journal->logCancelFlight(index);
+    }
+    flights[index].cancelled = true;
+
+    adj[flights[index].origin].remove(index);
+    adj[flights[index].destination].remove(index);
+}
+
+// Removes cancelled flights from the flight list and renumbers the arcs to
+// match, giving the same flight IDs a freshly written snapshot loads with
+template <typename W, bool Directed>
+void BasicGraph<W, Directed>::dropCancelledFlights()
+{
+    vector<int> newId(flights.size(), -1);
+    size_t kept = 0;
+    for (size_t i = 0; i < flights.size(); i++) {
+        if (!flights[i].cancelled) {
+            newId[i] = kept;
+            flights[kept++] = flights[i];
+        }
+    }
+    flights.erase(flights.begin() + kept, flights.end());
+
+    for (auto &arcs : adj) {
+        arcs.renumber(newId);
+    }
+}
+
+// Journal and snapshot files are written in native byte order
+static void putU8(string &buf, uint8_t v) {
+    buf.push_back(static_cast<char>(v));
+}
+
+static void putU32(string &buf, uint32_t v) {
+    buf.append(reinterpret_cast<const char *>(&v), sizeof v);
+}
+
+static void putString(string &buf, const string &s) {
+    putU32(buf, s.size());
+    buf.append(s);
+}
+
+// Bounds-checked reads over a file loaded into memory
+struct ByteReader {
+    const string &data;
+    size_t pos;
+
+    ByteReader(const string &data) : data(data), pos(0) {}
+
+    bool atEnd() const {
+        return pos == data.size();
+    }
+
+    bool u8(uint8_t &v) {
+        if (data.size() - pos < 1) return false;
+        v = static_cast<uint8_t>(data[pos++]);
+        return true;
+    }
+
+    bool u32(uint32_t &v) {
+        if (data.size() - pos < sizeof v) return false;
+        memcpy(&v, data.data() + pos, sizeof v);
+        pos += sizeof v;
+        return true;
+    }
+
+    bool str(string &s) {
+        uint32_t len;
+        if (!u32(len) || data.size() - pos < len) return false;
+        s.assign(data, pos, len);
+        pos += len;
+        return true;
+    }
+};
+
+static const char SNAPSHOT_MAGIC[] = "SNP3";
+static const char JOURNAL_MAGIC[] = "JRN3";
+
+static bool readFile(const string &path, string &contents) {
+    FILE *in = fopen(path.c_str(), "rb");
+    if (!in) {
+        return false;
+    }
+    contents.clear();
+    char chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof chunk, in)) > 0) {
+        contents.append(chunk, n);
+    }
+    fclose(in);
+    return true;
+}
+
+// Flush stdio's buffer and wait for the data to reach the disk. Returns
+// false if either step failed.
+static bool syncFile(FILE *f) {
+    if (fflush(f) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+
+// Cut the file at path back to size bytes
+static bool truncateFile(const string &path, long long size) {
+#ifdef _WIN32
+    int fd = _open(path.c_str(), _O_WRONLY | _O_BINARY);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = _chsize_s(fd, size) == 0 && _commit(fd) == 0;
+    _close(fd);
+    return ok;
+#else
+    return truncate(path.c_str(), size) == 0;
+#endif
+}
+
+// Rename from over to, replacing it, and make the rename itself durable. On
+// POSIX that means syncing the directory holding the entry.
+static bool replaceFile(const string &from, const string &to) {
+#ifdef _WIN32
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    if (rename(from.c_str(), to.c_str()) != 0) {
+        return false;
+    }
+    size_t slash = to.rfind('/');
+    string dir = slash == string::npos ? "." : (slash == 0 ? "/" : to.substr(0, slash));
+    int fd = open(dir.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+    return true;
+#endif
+}
+
+// A name to back path up under that is not taken yet: path.stale, then
+// path.stale.1, path.stale.2, ... so earlier backups are never overwritten
+static string freeBackupPath(const string &path) {
+    string backup = path + ".stale";
+    for (int n = 1; ; n++) {
+        FILE *existing = fopen(backup.c_str(), "rb");
+        if (!existing) {
+            return backup;
+        }
+        fclose(existing);
+        backup = path + ".stale." + to_string(n);
+    }
+}
+
+// Replace path with contents atomically: write a temporary file, sync it,
+// then rename it over the old one
+static bool writeFileAtomic(const string &path, const string &contents) {
+    string tmp = path + ".tmp";
+    FILE *out = fopen(tmp.c_str(), "wb");
+    if (!out) {
+        return false;
+    }
+    bool ok = fwrite(contents.data(), 1, contents.size(), out) == contents.size();
+    ok = syncFile(out) && ok;
+    ok = fclose(out) == 0 && ok;
+    return ok && replaceFile(tmp, path);
+}
+
+Journal::Journal(string snapshotPath, string journalPath) {
+    this->snapshotPath = snapshotPath;
+    this->journalPath = journalPath;
+    file = nullptr;
+    fileSize = 0;
+    pendingRecords = 0;
+    recordCount = 0;
+    generation = 0;
+}
+
+Journal::~Journal() {
+    commit();
+    if (file) {
+        fclose(file);
+    }
+}
+
+// Loads the base snapshot into an empty graph. Returns false if there is
+// none (or it is unreadable), leaving the graph untouched. An unreadable one
+// is moved aside to a .stale backup before the next compaction can replace it.
+template <typename G>
+bool Journal::loadSnapshot(G &g) {
+    string data;
+    if (!readFile(snapshotPath, data)) {
+        return false;
+    }
+
+    // Decode everything first so a bad file never leaves a half-built graph
+    ByteReader in(data);
+    in.pos = 4;
+    uint32_t format, gen, airportCount, flightCount;
+    vector<string> names;
+    vector<uint32_t> endpoints; // Origin and destination per flight
+    vector<typename G::Weight> distances;
+    bool ok = data.compare(0, 4, SNAPSHOT_MAGIC) == 0 && in.u32(format);
+
+    if (ok && format != graphFormat(g)) {
+        string backup = freeBackupPath(snapshotPath);
+        cout << RED << "Snapshot " << snapshotPath << " was written for a different weight type or direction, not loading it.";
+        if (replaceFile(snapshotPath, backup)) {
+            cout << " It was moved to " << backup;
+        } else {
+            cout << " It could not be moved to " << backup;
+        }
+        cout << RESET << endl;
+        return false;
+    }
+    ok = ok && in.u32(gen) && in.u32(airportCount);
+
+    for (uint32_t i = 0; ok && i < airportCount; i++) {
+        string name;
+        ok = in.str(name);
+        names.push_back(name);
+    }
+    ok = ok && in.u32(flightCount);
+    for (uint32_t i = 0; ok && i < flightCount; i++) {
+        uint32_t origin, destination, distance;
+        typename G::Weight w;
+        ok = in.u32(origin) && in.u32(destination) && in.u32(distance)
+             && origin < airportCount && destination < airportCount && weightFromBits(distance, w);
+        endpoints.push_back(origin);
+        endpoints.push_back(destination);
+        distances.push_back(w);
+    }
+
+    if (!ok || !in.atEnd()) {
+        string backup = freeBackupPath(snapshotPath);
+        cout << RED << "Snapshot " << snapshotPath << " is corrupt, ignoring it.";
+        if (replaceFile(snapshotPath, backup)) {
+            cout << " It was moved to " << backup;
+        } else {
+            cout << " It could not be moved to " << backup;
+        }
+        cout << RESET << endl;
+        return false;
+    }
+
+    for (const string &name : names) {
+        g.addAirport(name);
+    }
+    for (size_t i = 0; i < distances.size(); i++) {
+        g.addFlight(g.listOfAirports[endpoints[2 * i]], g.listOfAirports[endpoints[2 * i + 1]], distances[i]);
+    }
+    generation = gen;
+    return true;
+}
+
+// Applies the journal on top of the loaded snapshot and opens it for
+// appending. A journal from another generation (or an unreadable one) is
+// not replayed but moved aside to a new <journal>.stale backup, and a torn
+// record at the end (from a crash mid-write) is cut off after the original is
+// copied to one too, so nothing is thrown away without a copy. If the backup
+// cannot be made the journal is left as it is and not opened.
+template <typename G>
+int Journal::replay(G &g) {
+    string data, header;
+    header.append(JOURNAL_MAGIC, 4);
+    putU32(header, graphFormat(g));
+    putU32(header, generation);
+
+    if (!readFile(journalPath, data)) {
+        resetFile(header); // First run, nothing to replay
+        return 0;
+    }
+    if (data.compare(0, header.size(), header) != 0) {
+        string backup = freeBackupPath(journalPath);
+        // Another generation, or written for a different graph variant
+        cout << RED << "Journal " << journalPath << " does not belong to the loaded snapshot, not replaying it.";
+        if (replaceFile(journalPath, backup)) {
+            cout << " It was moved to " << backup << RESET << endl;
+            resetFile(header);
+        } else {
+            cout << " It could not be moved to " << backup << ", changes will not be saved." << RESET << endl;
+        }
+        return 0;
+    }
+
+    ByteReader in(data);
+    in.pos = header.size();
+    size_t good = in.pos;
+    int applied = 0;
+
+    while (!in.atEnd()) {
+        uint8_t type;
+        if (!in.u8(type)) {
+            break;
+        }
+
+        if (type == ADD_AIRPORT) {
+            string name;
+            if (!in.str(name)) break;
+            g.addAirport(name);
+        } else if (type == ADD_FLIGHT) {
+            uint32_t origin, destination, distance;
+            typename G::Weight w;
+            if (!in.u32(origin) || !in.u32(destination) || !in.u32(distance)) break;
+            if (origin >= g.listOfAirports.size() || destination >= g.listOfAirports.size()) break;
+            if (!weightFromBits(distance, w)) break;
+            g.addFlight(g.listOfAirports[origin], g.listOfAirports[destination], w);
+        } else if (type == CANCEL_FLIGHT) {
+            uint32_t index;
+            if (!in.u32(index) || index >= g.flights.size() || g.flights[index].cancelled) break;
+            g.removeFlight(index);
+        } else {
+            break;
+        }
+
+        good = in.pos;
+        applied++;
+    }
+
+    if (good != data.size()) {
+        string backup = freeBackupPath(journalPath);
+        cout << RED << "Journal " << journalPath << " has a damaged tail, keeping the first " << applied << " records.";
+        if (writeFileAtomic(backup, data)) {
+            cout << " The original was copied to " << backup << RESET << endl;
+            data.resize(good);
+            resetFile(data);
+        } else {
+            cout << " It could not be copied to " << backup << ", changes will not be saved." << RESET << endl;
+        }
+    } else {
+        file = fopen(journalPath.c_str(), "ab");
+        fileSize = data.size();
+    }
+
+    recordCount = applied;
+    return applied;
+}
+
+// Replace the journal file with contents and reopen it for appending. On
+// failure the journal is left closed and changes are only kept in memory.
+bool Journal::resetFile(const string &contents) {
+    if (file) {
+        fclose(file);
+    }
+    file = nullptr;
+    if (writeFileAtomic(journalPath, contents)) {
+        file = fopen(journalPath.c_str(), "ab");
+        fileSize = contents.size();
+    }
+    if (!file) {
+        cout << RED << "Cannot open journal " << journalPath << ", changes will not be saved." << RESET << endl;
+        return false;
+    }
+    return true;
+}
+
+void Journal::logAddAirport(const string &name) {
+    putU8(pending, ADD_AIRPORT);
+    putString(pending, name);
+    if (++pendingRecords >= BATCH_RECORDS) {
+        commit();
+    }
+}
+
+void Journal::logAddFlight(int origin, int destination, uint32_t weightBits) {
+    putU8(pending, ADD_FLIGHT);
+    putU32(pending, origin);
+    putU32(pending, destination);
+    putU32(pending, weightBits);
+    if (++pendingRecords >= BATCH_RECORDS) {
+        commit();
+    }
+}
+
+void Journal::logCancelFlight(int index) {
+    putU8(pending, CANCEL_FLIGHT);
+    putU32(pending, index);
+    if (++pendingRecords >= BATCH_RECORDS) {
+        commit();
+    }
+}
+
+// Write every buffered record and make them durable with a single fsync.
+// If the write or the sync fails (disk full, I/O error) the file is cut back
+// to its last whole record, so no torn record is left for later ones to sit
+// behind, and the batch stays pending to be retried by the next commit or
+// folded into the next snapshot. Returns false while records are pending.
+bool Journal::commit() {
+    if (pendingRecords == 0) {
+        return true;
+    }
+    if (!file) {
+        return false; // Already reported when the journal could not be opened
+    }
+
+    bool ok = fwrite(pending.data(), 1, pending.size(), file) == pending.size();
+    ok = syncFile(file) && ok;
+    if (!ok) {
+        cout << RED << "Cannot write journal " << journalPath << ", the last changes are not saved yet." << RESET << endl;
+        fclose(file);
+        file = nullptr;
+        if (truncateFile(journalPath, fileSize)) {
+            file = fopen(journalPath.c_str(), "ab");
+        }
+        if (!file) {
+            cout << RED << "Cannot open journal " << journalPath << ", changes will not be saved." << RESET << endl;
+        }
+        return false;
+    }
+
+    fileSize += pending.size();
+    recordCount += pendingRecords;
+    pending.clear();
+    pendingRecords = 0;
+    return true;
+}
+
+// Write the whole graph as the next generation's snapshot and start an
+// empty journal for it. Records that could not be committed are part of the
+// graph, so the snapshot makes them durable too.
+template <typename G>
+void Journal::compact(G &g) {
+    commit();
+
+    string data;
+    data.append(SNAPSHOT_MAGIC, 4);
+    putU32(data, graphFormat(g));
+    putU32(data, generation + 1);
+    putU32(data, g.listOfAirports.size());
+    for (auto a : g.listOfAirports) {
+        putString(data, a->name);
+    }
+    // Cancelled flights are dropped here, which renumbers the rest from the
+    // next generation on
+    size_t liveFlights = 0;
+    for (const auto &flight : g.flights) {
+        liveFlights += !flight.cancelled;
+    }
+    putU32(data, liveFlights);
+    for (const auto &flight : g.flights) {
+        if (flight.cancelled) {
+            continue;
+        }
+        putU32(data, flight.origin);
+        putU32(data, flight.destination);
+        putU32(data, weightToBits(flight.distance));
+    }
+
+    if (!writeFileAtomic(snapshotPath, data)) {
+        cout << RED << "Cannot write snapshot " << snapshotPath << RESET << endl;
+        return;
+    }
+
+    // The snapshot numbers only the live flights; switch memory over to the
+    // same numbering so cancellations logged from now on replay correctly
+    g.dropCancelledFlights();
+    pending.clear();
+    pendingRecords = 0;
+
+    generation++;
+    string header;
+    header.append(JOURNAL_MAGIC, 4);
+    putU32(header, graphFormat(g));
+    putU32(header, generation);
+    resetFile(header);
+    recordCount = 0;
+}
+
+template <typename G>
+void Journal::compactIfNeeded(G &g) {
+    // Uncommitted records count too: a snapshot is how they get saved once the
+    // journal cannot be written
+    if (recordCount + pendingRecords >= COMPACT_RECORDS || (!file && pendingRecords > 0)) {
+        compact(g);
+    }
+}
+
+pair<PAirport, PAirport> getSourceAndDestinationAirports(Graph &g) {
     auto len = g.listOfAirports.size();
     bool validInput = false;
     int src = -1, dest = -1;
@@ -439,11 +1790,7 @@ vector<PAirport>* getSourceAndDestinationAirports(Graph &g) {
     PAirport srcAirport = g.listOfAirports[src - 1];
     PAirport destAirport = g.listOfAirports[dest - 1];
 
-    vector<PAirport>* srcAndDest = new vector<PAirport>;
-    srcAndDest->push_back(srcAirport);
-    srcAndDest->push_back(destAirport);
-
-    return srcAndDest;
+    return make_pair(srcAirport, destAirport);
 }
 
 int boxDelivering(vector<vector<int>>& boxes, int portsCount, int maxBoxes, int maxWeight) {
@@ -561,20 +1908,22 @@ int main()
     loadingScreen(); // Show loading screen
 
     Graph g;
-
-    PAirport a1 = new Airport("New Delhi");
-    PAirport a2 = new Airport("Mumbai");
-    PAirport a3 = new Airport("Lucknow");
-    PAirport a4 = new Airport("Chennai");
-    g.addAirport(a1);
-    g.addAirport(a2);
-    g.addAirport(a3);
-    g.addAirport(a4);
-
-    g.addFlight(a1, a2, 500, true);
-    g.addFlight(a2, a3, 150, true);
-    g.addFlight(a1, a3, 100, true);
-    g.addFlight(a1, a4, 600, true);
+    Journal journal("flights.snapshot", "flights.journal");
+
+    // Start from the last snapshot, or the built-in network the first time
+    if (!journal.loadSnapshot(g)) {
+        PAirport a1 = g.addAirport("New Delhi");
+        PAirport a2 = g.addAirport("Mumbai");
+        PAirport a3 = g.addAirport("Lucknow");
+        PAirport a4 = g.addAirport("Chennai");
+
+        g.addFlight(a1, a2, 500);
+        g.addFlight(a2, a3, 150);
+        g.addFlight(a1, a3, 100);
+        g.addFlight(a1, a4, 600);
+    }
+    journal.replay(g);
+    g.journal = &journal; // Record every change from here on
 
     char choice = 'y';
     do
@@ -608,15 +1957,33 @@ int main()
     | 10. To Get shortest Flight Distance to |
     |    your destination.(A*)               |
     |                                        |
-    | 11. To Exit.                           |
+    | 11. To find Airports reachable within  |
+    |    a distance.                         |
+    |                                        |
+    | 12. To find Airports reachable within  |
+    |    a number of flights.                |
+    |                                        |
+    | 13. To Create an Airport Group.        |
+    |                                        |
+    | 14. To Get shortest Flight Distance    |
+    |    between two Airport Groups.         |
+    |                                        |
+    | 15. To Get shortest Flight Route as    |
+    |    JSON.                               |
+    |                                        |
+    | 16. To View Flight Distances from an   |
+    |    Airport to every other Airport.     |
+    |                                        |
+    | 17. To Exit.                           |
     +----------------------------------------+
     )" << RESET << endl;
 
     cout << GREEN << "Enter your choice: " << RESET;
         
         cin >> ch;
-        if (ch == 11)
+        if (ch == 17)
         {
+            journal.commit();
             exit(0);
         }
         else
@@ -626,9 +1993,9 @@ int main()
                 case 1:
                 {
                     system("cls || clear");
-                    vector<PAirport>* srcAndDest = getSourceAndDestinationAirports(g);
-                    PAirport srcAirport = (*srcAndDest)[0];
-                    PAirport destAirport = (*srcAndDest)[1];
+                    pair<PAirport, PAirport> srcAndDest = getSourceAndDestinationAirports(g);
+                    PAirport srcAirport = srcAndDest.first;
+                    PAirport destAirport = srcAndDest.second;
                     g.shortestPath(srcAirport, destAirport);
                     break;
                 }
@@ -638,19 +2005,17 @@ int main()
                     cout <<GREEN "\n\n Enter Name of the New Airport:\n" << endl;
                     string st;
                     cin >> st;
-                    PAirport a5 = new Airport(st);
-                    g.addAirport(a5);
-                    dist[a5] = INT_MAX;
+                    g.addAirport(st);
                     break;
                 }
                 case 3:
                 {
                     system("cls || clear");
-                    vector<PAirport>* srcAndDest = getSourceAndDestinationAirports(g);
-                    PAirport srcAirport = (*srcAndDest)[0];
-                    PAirport destAirport = (*srcAndDest)[1];
+                    pair<PAirport, PAirport> srcAndDest = getSourceAndDestinationAirports(g);
+                    PAirport srcAirport = srcAndDest.first;
+                    PAirport destAirport = srcAndDest.second;
 
-                    if (doesPathExist(destAirport)) {
+                    if (g.doesPathExist(srcAirport, destAirport)) {
                         g.PrintAllPaths(srcAirport, destAirport);
                     } else {
                         cout << "No Path Exists between " << srcAirport->name << " and " << destAirport->name << endl;
@@ -755,23 +2120,122 @@ int main()
                 case 10:
                 {
                     system("cls || clear");
-                    vector<PAirport>* srcAndDest = getSourceAndDestinationAirports(g);
-                    PAirport srcAirport = (*srcAndDest)[0];
-                    PAirport destAirport = (*srcAndDest)[1];
+                    pair<PAirport, PAirport> srcAndDest = getSourceAndDestinationAirports(g);
+                    PAirport srcAirport = srcAndDest.first;
+                    PAirport destAirport = srcAndDest.second;
                     g.aStarPath(srcAirport, destAirport);
                     break;
                 }
+                case 11:
+                case 12:
+                {
+                    system("cls || clear");
+                    string name;
+                    double limit;
+                    cout << "Enter Source Airport Name: ";
+                    cin >> name;
+                    cout << (ch == 11 ? "Enter Maximum Distance (km): " : "Enter Maximum Number of Flights: ");
+                    cin >> limit;
+
+                    PAirport srcAirport = g.SearchAirport(name);
+                    Graph::ReachResult result;
+                    if (!srcAirport) {
+                        cout << "Invalid airport entered!\n";
+                    } else if (!(limit >= 0)) {
+                        cout << "Invalid limit entered!\n";
+                    } else if (ch == 11) {
+                        // Anything past the largest distance means "no limit"
+                        Graph::Distance maxDistance = numeric_limits<Graph::Distance>::max();
+                        if (limit < static_cast<double>(maxDistance)) {
+                            maxDistance = static_cast<Graph::Distance>(limit);
+                        }
+                        g.reachableWithinDistance(srcAirport, maxDistance, result);
+                        g.printReachable(result, "km");
+                    } else {
+                        int maxFlights = limit < static_cast<double>(INT_MAX) ? static_cast<int>(limit) : INT_MAX;
+                        g.reachableWithinFlights(srcAirport, maxFlights, result);
+                        g.printReachable(result, "flights");
+                    }
+                    break;
+                }
+                case 13:
+                {
+                    system("cls || clear");
+                    string groupName, name;
+                    int n;
+                    cout << "Enter Name of the New Airport Group: ";
+                    cin >> groupName;
+                    cout << "Enter number of Airports in the Group: ";
+                    cin >> n;
+
+                    AirportGroup* group = g.addGroup(groupName);
+                    for (int i = 0; i < n; i++) {
+                        cout << "Enter Airport Name " << i + 1 << ": ";
+                        cin >> name;
+                        PAirport a = g.SearchAirport(name);
+                        if (a) {
+                            group->members.push_back(a);
+                        } else {
+                            cout << "Invalid airport entered, skipping!\n";
+                        }
+                    }
+                    cout << "Airport Group created with " << group->members.size() << " airports.\n";
+                    break;
+                }
+                case 14:
+                {
+                    system("cls || clear");
+                    string fromName, toName;
+                    cout << "Enter Origin Airport Group Name: ";
+                    cin >> fromName;
+                    cout << "Enter Destination Airport Group Name: ";
+                    cin >> toName;
+
+                    AirportGroup* from = g.SearchGroup(fromName);
+                    AirportGroup* to = g.SearchGroup(toName);
+                    if (from && to) {
+                        g.groupShortestPath(*from, *to);
+                    } else {
+                        cout << "Invalid airport groups entered!\n";
+                    }
+                    break;
+                }
+                case 15:
+                {
+                    system("cls || clear");
+                    pair<PAirport, PAirport> srcAndDest = getSourceAndDestinationAirports(g);
+                    g.shortestPath(srcAndDest.first, srcAndDest.second, true);
+                    break;
+                }
+                case 16:
+                {
+                    system("cls || clear");
+                    string name;
+                    cout << "Enter Source Airport Name: ";
+                    cin >> name;
+
+                    PAirport srcAirport = g.SearchAirport(name);
+                    if (srcAirport) {
+                        vector<Graph::Distance> table;
+                        g.distanceTable(srcAirport, table);
+                        g.printDistanceTable(srcAirport, table);
+                    } else {
+                        cout << "Invalid airport entered!\n";
+                    }
+                    break;
+                }
             }
         }
+        // Make this action's changes durable before asking for the next one
+        journal.commit();
+        journal.compactIfNeeded(g);
+
         cout <<GREEN "\n\n\nDo you want to go to the main page or not?(Y/N)\n";
         cin >> choice;
         system("cls || clear");
 
     } while (choice == 'y' || choice == 'Y');
 
-    for (auto &v : g.listOfAirports) {
-        delete v;
-    }
-
+    // Airports are owned by the Graph and released with it
     return 0;
 }